@@ -8,8 +8,11 @@
  *   X11 client
  *   draws to an X11 window.
  *   uses one supporting thread to manage the X11 display connection and input.
+ * #ifdef _USE_HEADLESS
+ *   no display at all, for benchmarking and automated testing.
+ *   renders only into fb_canvas, no supporting threads, no mouse or keyboard.
  *
- * Both systems use a memory array named fb_canvas as a pixel-by-pixel rendering surface. This is
+ * All systems use a memory array named fb_canvas as a pixel-by-pixel rendering surface. This is
  * periodically copied to fb_stage on change. _USE_FB0 uses a third copy fb_cursor in which to draw cursor.
  * FB_X0 and FB_Y0 are the upper left coords on the hardware of drawing area FB_YRES x FB_XRES.
  *
@@ -145,6 +148,13 @@ Adafruit_RA8875::Adafruit_RA8875(uint8_t CS, uint8_t RST)
         // insure earth map pointers are NULL until set
         DEARTH_BIG = NULL;
         NEARTH_BIG = NULL;
+        DEARTH_FB = NULL;
+        NEARTH_FB = NULL;
+
+        // mercator tables are built when first needed
+        merc_col = NULL;
+        merc_row = NULL;
+        merc_clng = -1000;
 
         // not ready until proven
         ready = false;
@@ -160,6 +170,12 @@ void Adafruit_RA8875::setEarthPix (char *day_pixels, char *night_pixels)
 
 }
 
+void Adafruit_RA8875::setEarthFBPix (char *day_fbpix, char *night_fbpix)
+{
+        DEARTH_FB = (fbpix_t(*)[EARTH_BIG_H][EARTH_BIG_W]) day_fbpix;
+        NEARTH_FB = (fbpix_t(*)[EARTH_BIG_H][EARTH_BIG_W]) night_fbpix;
+}
+
 bool Adafruit_RA8875::begin (int not_used)
 {
         (void)not_used;
@@ -441,6 +457,69 @@ bool Adafruit_RA8875::begin (int not_used)
 	return (true);
 
 #endif // _USE_FB0
+
+#ifdef _USE_HEADLESS
+
+	// fixed scale, no borders
+	fb_si.xres = FB_XRES;
+	fb_si.yres = FB_YRES;
+        SCALESZ = FB_XRES / APP_WIDTH;
+        FB_CURSOR_SZ = FB_CURSOR_W*SCALESZ;
+        FB_X0 = 0;
+        FB_Y0 = 0;
+        fb_nbytes = FB_XRES * FB_YRES * BYTESPFBPIX;
+
+	// get memory for canvas where the drawing methods update their pixels
+	fb_canvas = (fbpix_t *) malloc (fb_nbytes);
+	if (!fb_canvas) {
+	    printf ("Can not malloc(%d) for canvas\n", fb_nbytes);
+	    exit(1);
+	}
+	memset (fb_canvas, 0, fb_nbytes);       // black
+
+	// stage is just the most recently "presented" canvas
+	fb_stage = (fbpix_t *) malloc (fb_nbytes);
+	if (!fb_stage) {
+	    printf ("Can not malloc(%d) for stage\n", fb_nbytes);
+	    exit(1);
+	}
+	memset (fb_stage, 0, fb_nbytes);
+
+	// mouse is never seen and no keys are ever typed but locks are still used
+	if (pthread_mutex_init (&mouse_lock, NULL)) {
+	    printf ("mouse_lock: %s\n", strerror(errno));
+	    exit(1);
+	}
+	mouse_downs = mouse_ups = 0;
+	mouse_x = mouse_y = -1;
+	mouse_idle = MOUSE_FADE + 1;
+	if (pthread_mutex_init (&kb_lock, NULL)) {
+	    printf ("kb_lock: %s\n", strerror(errno));
+	    exit(1);
+	}
+	kb_cqhead = kb_cqtail = 0;
+
+	// set up a reentrantable lock for fb
+	pthread_mutexattr_t fb_attr;
+	pthread_mutexattr_init (&fb_attr);
+	pthread_mutexattr_settype (&fb_attr, PTHREAD_MUTEX_RECURSIVE);
+	if (pthread_mutex_init (&fb_lock, &fb_attr)) {
+	    printf ("fb_lock: %s\n", strerror(errno));
+	    exit(1);
+	}
+
+	// start with default font
+	current_font = &Courier_Prime_Sans6pt7b;
+
+        // screen is exactly our size
+        screen_w = FB_XRES;
+        screen_h = FB_YRES;
+
+	// no thread to wait for
+        ready = true;
+	return (true);
+
+#endif // _USE_HEADLESS
 }
 
 bool Adafruit_RA8875::displayReady()
@@ -1381,6 +1460,106 @@ float dlatr, float dlngr, float dlatd, float dlngd, float fract_day)
 	}
 }
 
+/* same as plotEarth for the special case of mercator projection at app's screen location x0,y0.
+ * the map column then depends only on screen x and center_lng and the map row only on screen y, so we
+ * gather each subpixel from the map using tables built once per center_lng and map size, and blend
+ * using fixed point.
+ */
+void Adafruit_RA8875::plotEarthMerc (uint16_t x0, uint16_t y0, uint16_t map_x, uint16_t map_y,
+int16_t center_lng, float fract_day)
+{
+        // beware of no map files
+        if (!DEARTH_BIG || !NEARTH_BIG)
+            return;
+
+        // rows only depend on map size which is fixed for the build
+        if (!merc_row) {
+            merc_row = (uint32_t *) malloc (EARTH_BIG_H * sizeof(uint32_t));
+            if (!merc_row) {
+                printf ("Can not malloc(%d) for merc_row\n", (int)(EARTH_BIG_H * sizeof(uint32_t)));
+                exit(1);
+            }
+            for (int r = 0; r < EARTH_BIG_H; r++)
+                merc_row[r] = r * EARTH_BIG_W;
+        }
+
+        // cols change with center_lng
+        if (!merc_col || center_lng != merc_clng) {
+            if (!merc_col) {
+                merc_col = (uint16_t *) malloc (EARTH_BIG_W * sizeof(uint16_t));
+                if (!merc_col) {
+                    printf ("Can not malloc(%d) for merc_col\n", (int)(EARTH_BIG_W * sizeof(uint16_t)));
+                    exit(1);
+                }
+            }
+            int shift = (int)floorf (center_lng*EARTH_BIG_W/360.0F + 0.5F) + EARTH_BIG_W;
+            for (int c = 0; c < EARTH_BIG_W; c++)
+                merc_col[c] = (c + shift) % EARTH_BIG_W;
+            merc_clng = center_lng;
+        }
+
+        // fb and map coords of first subpixel
+        x0 *= SCALESZ;
+        y0 *= SCALESZ;
+        int mx0 = x0 - map_x*SCALESZ;
+        int my0 = y0 - map_y*SCALESZ;
+        if (mx0 < 0 || my0 < 0 || mx0 + SCALESZ > EARTH_BIG_W || my0 + SCALESZ > EARTH_BIG_H)
+            return;
+        const uint16_t *cols = &merc_col[mx0];
+        const uint16_t *day_pix = &(*DEARTH_BIG)[0][0];
+        const uint16_t *night_pix = &(*NEARTH_BIG)[0][0];
+
+        // fixed point day fraction, 0 .. 256
+        int fd = (int)(fract_day*256 + 0.5F);
+
+        // full day or night can copy directly from native maps if available
+        const fbpix_t *fb_pix = NULL;
+        if (fd == 256 && DEARTH_FB)
+            fb_pix = &(*DEARTH_FB)[0][0];
+        else if (fd == 0 && NEARTH_FB)
+            fb_pix = &(*NEARTH_FB)[0][0];
+        if (fb_pix) {
+            // one run per row unless the subpixels straddle the map seam
+            bool one_run = cols[SCALESZ-1] == cols[0] + SCALESZ - 1;
+            for (int r = 0; r < SCALESZ; r++) {
+                fbpix_t *frow = &fb_canvas[(y0+r)*FB_XRES + x0];
+                const fbpix_t *mrow = fb_pix + merc_row[my0+r];
+                if (one_run)
+                    memcpy (frow, mrow + cols[0], SCALESZ*sizeof(fbpix_t));
+                else
+                    for (int c = 0; c < SCALESZ; c++)
+                        *frow++ = mrow[cols[c]];
+            }
+            return;
+        }
+
+	for (int r = 0; r < SCALESZ; r++) {
+	    fbpix_t *frow = &fb_canvas[(y0+r)*FB_XRES + x0];
+            const uint32_t row = merc_row[my0+r];
+            if (fd == 0) {
+                const uint16_t *nrow = night_pix + row;
+                for (int c = 0; c < SCALESZ; c++)
+                    *frow++ = RGB16TOFBPIX(nrow[cols[c]]);
+            } else if (fd == 256) {
+                const uint16_t *drow = day_pix + row;
+                for (int c = 0; c < SCALESZ; c++)
+                    *frow++ = RGB16TOFBPIX(drow[cols[c]]);
+            } else {
+                const uint16_t *drow = day_pix + row;
+                const uint16_t *nrow = night_pix + row;
+                int fn = 256 - fd;
+                for (int c = 0; c < SCALESZ; c++) {
+                    uint16_t d16 = drow[cols[c]];
+                    uint16_t n16 = nrow[cols[c]];
+                    uint8_t twi_r = (fd*RGB565_R(d16) + fn*RGB565_R(n16)) >> 8;
+                    uint8_t twi_g = (fd*RGB565_G(d16) + fn*RGB565_G(n16)) >> 8;
+                    uint8_t twi_b = (fd*RGB565_B(d16) + fn*RGB565_B(n16)) >> 8;
+                    *frow++ = RGB16TOFBPIX(RGB565 (twi_r, twi_g, twi_b));
+                }
+            }
+	}
+}
+
 void Adafruit_RA8875::plotChar (char ch)
 {
 	if (ch < current_font->first || ch > current_font->last)
@@ -1422,11 +1601,21 @@ void Adafruit_RA8875::setPR (uint16_t x, uint16_t y, uint16_t w, uint16_t h)
  */
 void Adafruit_RA8875::drawPR(void)
 {
+#if defined(_USE_HEADLESS)
+        // no drawing thread so present everything right here
+	pthread_mutex_lock (&fb_lock);
+            pr_draw = true;
+            drawCanvas();
+            fb_dirty = false;
+            pr_draw = false;
+	pthread_mutex_unlock (&fb_lock);
+#else
         // set flag to inform the drawing thread to draw the pr region, wait until finished.
         // if you know of a better way with mutexes etc let me know
         pr_draw = true;
         while (pr_draw)
             usleep (1000);
+#endif
 }
 
 
@@ -2279,3 +2468,31 @@ void Adafruit_RA8875::getScreenSize (int *w, int *h)
 }
 
 #endif // _USE_FB0
+
+#ifdef _USE_HEADLESS
+
+// nothing to engage
+// _USE_HEADLESS
+void Adafruit_RA8875::X11OptionsEngageNow (bool fs)
+{
+        (void)(fs);
+}
+
+/* "present" fb_canvas by copying it to fb_stage.
+ * N.B. we assume fb_lock is held
+ */
+// _USE_HEADLESS
+void Adafruit_RA8875::drawCanvas()
+{
+        memcpy (fb_stage, fb_canvas, fb_nbytes);
+}
+
+// return virtual display dimensions
+// _USE_HEADLESS
+void Adafruit_RA8875::getScreenSize (int *w, int *h)
+{
+        *w = FB_XRES;
+        *h = FB_YRES;
+}
+
+#endif // _USE_HEADLESS
@@ -35,6 +35,17 @@ struct fb_var_screeninfo {
 
 #endif	// _USE_FB0
 
+#ifdef _USE_HEADLESS
+
+#include <sys/time.h>
+
+// no display hardware at all, just enough to share the X11 structure
+struct fb_var_screeninfo {
+    int xres, yres;
+};
+
+#endif // _USE_HEADLESS
+
 #include "gfxfont.h"
 extern const GFXfont Courier_Prime_Sans6pt7b;
 
@@ -166,6 +177,10 @@ class Adafruit_RA8875 {
 	void plotEarth (uint16_t x0, uint16_t y0, float lat0, float lng0,
             float dlatr, float dlngr, float dlatd, float dlngd, float fract_day);
 
+	// faster special case of plotEarth for mercator projection
+	void plotEarthMerc (uint16_t x0, uint16_t y0, uint16_t map_x, uint16_t map_y, int16_t center_lng,
+            float fract_day);
+
         // methods to implement a protected rectangle drawn only with drawPR()
         void setPR (uint16_t x, uint16_t y, uint16_t w, uint16_t h);
         void drawPR(void);
@@ -184,6 +199,9 @@ class Adafruit_RA8875 {
 
         void setEarthPix (char *day_pixels, char *night_pixels);
 
+        // optional copies of the same maps already in native fbpix_t format
+        void setEarthFBPix (char *day_fbpix, char *night_fbpix);
+
         // used to engage/disengage X11 fullscreen
         void X11OptionsEngageNow (bool fullscreen);
 
@@ -329,6 +347,13 @@ class Adafruit_RA8875 {
 	// big earth mmap'd maps
         uint16_t (*DEARTH_BIG)[EARTH_BIG_H][EARTH_BIG_W];
         uint16_t (*NEARTH_BIG)[EARTH_BIG_H][EARTH_BIG_W];
+        fbpix_t (*DEARTH_FB)[EARTH_BIG_H][EARTH_BIG_W];
+        fbpix_t (*NEARTH_FB)[EARTH_BIG_H][EARTH_BIG_W];
+
+        // plotEarthMerc index tables: map column for each fb column, offset of map row for each fb row
+        uint16_t *merc_col;
+        uint32_t *merc_row;
+        int16_t merc_clng;              // center_lng for which merc_col was built
 
 };
 
@@ -15,6 +15,8 @@
 
 char **our_argv;                // our argv for restarting
 std::string our_dir;            // our storage directory, including trailing /
+uint32_t fake_clock_t0;         // if set: UNIX time at which the repeatable fake clock starts
+const char *canned_dir;         // if set: serve all svr_host requests from files in this dir
 
 
 // how we were made
@@ -38,15 +40,32 @@ std::string our_dir;            // our storage directory, including trailing /
   #else
       char our_make[] = "hamclock-800x480";
   #endif
+#elif defined(_USE_HEADLESS)
+  #if defined(_CLOCK_1600x960)
+      char our_make[] = "hamclock-headless-1600x960";
+  #elif defined(_CLOCK_2400x1440)
+      char our_make[] = "hamclock-headless-2400x1440";
+  #elif defined(_CLOCK_3200x1920)
+      char our_make[] = "hamclock-headless-3200x1920";
+  #else
+      char our_make[] = "hamclock-headless-800x480";
+  #endif
 #else
   #error Unknown build configuration
 #endif
  
 
-/* return milliseconds since first call
+// fake clock, advanced only by calls to millis() and delay()
+static uint32_t fake_ms;
+
+/* return milliseconds since first call.
+ * with a fake clock each call advances 1 ms so runs are repeatable regardless of real time.
  */
 uint32_t millis(void)
 {
+	if (fake_clock_t0)
+	    return (fake_ms++);
+
 	static struct timeval t0;
 
 	struct timeval t;
@@ -62,7 +81,10 @@ uint32_t millis(void)
 
 void delay (uint32_t ms)
 {
-	usleep (ms*1000);
+	if (fake_clock_t0)
+	    fake_ms += ms;              // time passes but without waiting for it
+	else
+	    usleep (ms*1000);
 }
 
 long random(int max)
@@ -176,6 +198,7 @@ static void usage (const char *errfmt, ...)
         fprintf (stderr, "Usage: %s [options]\n", me);
         fprintf (stderr, "Options:\n");
         fprintf (stderr, " -b h : set backend host to h instead of %s\n", svr_host);
+        fprintf (stderr, " -c d : serve backend requests from canned files in dir d, no other network\n");
         fprintf (stderr, " -d d : set working dir d instead of %s\n", defaultAppDir().c_str());
         fprintf (stderr, " -f o : display full screen initially \"on\" or \"off\"\n");
         fprintf (stderr, " -g   : init DE using geolocation with our IP; requires -k\n");
@@ -184,6 +207,7 @@ static void usage (const char *errfmt, ...)
         fprintf (stderr, " -l l : set mercator center lng to l degs; requires -k\n");
         fprintf (stderr, " -m   : enable demo mode\n");
         fprintf (stderr, " -o   : write diagnostic log to stdout instead of in working dir\n");
+        fprintf (stderr, " -t t : use a repeatable fake clock starting at UNIX time t\n");
         fprintf (stderr, " -w p : set web server port p instead of %d\n", svr_port);
 
         exit(1);
@@ -209,6 +233,12 @@ static void crackArgs (int ac, char *av[])
                     svr_host = *++av;
                     ac--;
                     break;
+                case 'c':
+                    if (ac < 2)
+                        usage ("missing directory path for -c");
+                    canned_dir = *++av;
+                    ac--;
+                    break;
                 case 'd':
                     if (ac < 2)
                         usage ("missing directory path for -d");
@@ -256,6 +286,14 @@ static void crackArgs (int ac, char *av[])
                     diag_to_file = false;
                     break;
                     break;
+                case 't':
+                    if (ac < 2)
+                        usage ("missing UNIX time for -t");
+                    fake_clock_t0 = strtoul (*++av, NULL, 10);
+                    if (fake_clock_t0 == 0)
+                        usage ("-t requires a positive UNIX time");
+                    ac--;
+                    break;
                 case 'w':
                     if (ac < 2)
                         usage ("missing port number for -w");
@@ -301,6 +339,13 @@ int main (int ac, char *av[])
         // always want stdout synchronous 
         setbuf (stdout, NULL);
 
+#if defined(_BENCH)
+        // benchmark harness runs instead of the app
+        (void) ac;
+        runBenchmarks();
+        return (0);
+#endif
+
         // check args
         crackArgs (ac, av);
 
@@ -80,6 +80,8 @@ extern void loop(void);
 extern char **our_argv;
 extern char our_make[];
 extern std::string our_dir;
+extern uint32_t fake_clock_t0;
+extern const char *canned_dir;
 
 #include "ESP.h"
 #include "Serial.h"
@@ -90,6 +92,7 @@ extern void setX11FullScreen (bool);
 extern void setDemoMode(bool on);
 extern void setCenterLng (int16_t l);
 extern void fatalError (const char *fmt, ...);
+extern void runBenchmarks (void);
 extern const char *svr_host;
 extern int svr_port;
 extern bool skip_skip;
@@ -130,6 +130,12 @@ IPAddress WiFi::localIP(void)
         if (a[0] != 0)
             return (a);
 
+        // no network at all when serving canned data
+        if (canned_dir) {
+            a = IPAddress (127, 0, 0, 1);
+            return (a);
+        }
+
         // create socket back to home base then get our IP from that
         const char *host = "clearskyinstitute.com";
         const int port = 80;
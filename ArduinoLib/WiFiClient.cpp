@@ -9,11 +9,170 @@
 // set for core info
 static bool _trace_client = false;
 
+// idle HTTP sockets kept open for reuse by the next connect() to the same host:port
+#define POOL_MAX        4               // max idle sockets
+#define POOL_IDLE_S     60              // max seconds idle, servers may close sooner which we detect
+typedef struct {
+    std::string host_port;              // "host:port"
+    int fd;                             // idle socket
+    time_t t0;                          // time when became idle
+} PoolEntry;
+static PoolEntry pool[POOL_MAX];
+static int n_pool;
+
+// recent host name lookups
+#define DNS_MAX         8               // max hosts remembered
+#define DNS_TTL_S       300             // seconds to trust an address
+typedef struct {
+    std::string host;                   // name as given to connect()
+    struct sockaddr_in addr;            // resolved address, port not used
+    time_t expires;                     // time when this entry is no longer trusted
+} DNSEntry;
+static DNSEntry dns_cache[DNS_MAX];
+static int n_dns;
+
+// protects pool and dns_cache
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+
+
+/* return an idle socket to host_port if one is still good, else -1
+ */
+static int poolGet (const std::string &host_port)
+{
+        int fd = -1;
+
+        pthread_mutex_lock (&pool_lock);
+        time_t now = time(NULL);
+        for (int i = 0; i < n_pool; ) {
+            PoolEntry &pe = pool[i];
+            bool stale = now - pe.t0 > POOL_IDLE_S;
+            bool match = !stale && fd < 0 && pe.host_port == host_port;
+            if (match) {
+                // any input at all on an idle socket means server closed or it is out of step
+                struct pollfd pfd;
+                pfd.fd = pe.fd;
+                pfd.events = POLLIN;
+                if (poll (&pfd, 1, 0) != 0)
+                    stale = true;
+            }
+            if (stale || match) {
+                if (stale) {
+                    printf ("WiFiCl: idle socket %d to %s is stale\n", pe.fd, pe.host_port.c_str());
+                    close (pe.fd);
+                } else
+                    fd = pe.fd;
+                pool[i] = pool[--n_pool];
+            } else
+                i++;
+        }
+        pthread_mutex_unlock (&pool_lock);
+
+        return (fd);
+}
+
+/* add fd to the idle pool for host_port, replacing the oldest if full
+ */
+static void poolPut (const std::string &host_port, int fd)
+{
+        pthread_mutex_lock (&pool_lock);
+        if (n_pool == POOL_MAX) {
+            int oldest = 0;
+            for (int i = 1; i < n_pool; i++)
+                if (pool[i].t0 < pool[oldest].t0)
+                    oldest = i;
+            close (pool[oldest].fd);
+            pool[oldest] = pool[--n_pool];
+        }
+        PoolEntry &pe = pool[n_pool++];
+        pe.host_port = host_port;
+        pe.fd = fd;
+        pe.t0 = time(NULL);
+        pthread_mutex_unlock (&pool_lock);
+}
+
+/* look up host, using dns_cache if possible.
+ * set *cachedp to whether the address came from the cache.
+ * return whether ok.
+ */
+static bool dnsLookup (const char *host, struct sockaddr_in &addr, bool *cachedp)
+{
+        // check cache
+        pthread_mutex_lock (&pool_lock);
+        time_t now = time(NULL);
+        for (int i = 0; i < n_dns; i++) {
+            if (dns_cache[i].host == host && now < dns_cache[i].expires) {
+                addr = dns_cache[i].addr;
+                pthread_mutex_unlock (&pool_lock);
+                *cachedp = true;
+                return (true);
+            }
+        }
+        pthread_mutex_unlock (&pool_lock);
+
+        /* lookup host address.
+         * N.B. must call freeaddrinfo(aip) after successful call before returning
+         */
+        struct addrinfo hints, *aip;
+        memset (&hints, 0, sizeof(hints));
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_STREAM;
+        int error = ::getaddrinfo (host, NULL, &hints, &aip);
+        if (error) {
+            printf ("getaddrinfo(%s): %s\n", host, gai_strerror(error));
+            return (false);
+        }
+        memcpy (&addr, aip->ai_addr, sizeof(addr));
+        freeaddrinfo (aip);
+
+        // add to cache, replacing the expired or oldest
+        pthread_mutex_lock (&pool_lock);
+        int slot = -1;
+        for (int i = 0; i < n_dns; i++) {
+            if (dns_cache[i].host == host) {
+                slot = i;
+                break;
+            }
+        }
+        if (slot < 0) {
+            if (n_dns < DNS_MAX)
+                slot = n_dns++;
+            else {
+                slot = 0;
+                for (int i = 1; i < n_dns; i++)
+                    if (dns_cache[i].expires < dns_cache[slot].expires)
+                        slot = i;
+            }
+        }
+        dns_cache[slot].host = host;
+        dns_cache[slot].addr = addr;
+        dns_cache[slot].expires = now + DNS_TTL_S;
+        pthread_mutex_unlock (&pool_lock);
+
+        *cachedp = false;
+        return (true);
+}
+
+/* remove host from dns_cache, if present
+ */
+static void dnsForget (const char *host)
+{
+        pthread_mutex_lock (&pool_lock);
+        for (int i = 0; i < n_dns; i++) {
+            if (dns_cache[i].host == host) {
+                dns_cache[i] = dns_cache[--n_dns];
+                break;
+            }
+        }
+        pthread_mutex_unlock (&pool_lock);
+}
+
 WiFiClient::WiFiClient()
 {
 	socket = -1;
 	n_peek = 0;
         next_peek = 0;
+        canned = canned_sent = false;
+        resetHTTP();
 }
 
 WiFiClient::WiFiClient(int fd)
@@ -22,6 +181,24 @@ WiFiClient::WiFiClient(int fd)
 	socket = fd;
 	n_peek = 0;
         next_peek = 0;
+        canned = canned_sent = false;
+        resetHTTP();
+}
+
+/* forget any HTTP exchange
+ */
+void WiFiClient::resetHTTP()
+{
+        http_state = HS_NONE;
+        http_line.clear();
+        http_left = 0;
+        http_clen = -1;
+        http_status = 0;
+        http_chunked = false;
+        http_keep = false;
+        http_reused = false;
+        http_got_resp = false;
+        http_req.clear();
 }
 
 // return whether this socket is active
@@ -92,39 +269,120 @@ int WiFiClient::tout (int to_ms, int fd)
 }
 
 
-bool WiFiClient::connect(const char *host, int port)
+/* "connect" to host when running with canned_dir.
+ * only svr_host is allowed, the reply is decided later by cannedRequest() when the request arrives.
+ * until then the socket is /dev/null so it looks open but never offers any data.
+ */
+bool WiFiClient::cannedConnect (const char *host, int port)
 {
-        struct addrinfo hints, *aip;
-        char port_str[16];
-        int sockfd;
+        if (strcmp (host, svr_host) != 0) {
+            printf ("WiFiCl: canned mode refuses %s:%d\n", host, port);
+            return (false);
+        }
 
-        /* lookup host address.
-         * N.B. must call freeaddrinfo(aip) after successful call before returning
-         */
-        memset (&hints, 0, sizeof(hints));
-        hints.ai_family = AF_INET;
-        hints.ai_socktype = SOCK_STREAM;
-        sprintf (port_str, "%d", port);
-        int error = ::getaddrinfo (host, port_str, &hints, &aip);
-        if (error) {
-            printf ("getaddrinfo(%s:%d): %s\n", host, port, gai_strerror(error));
+        int fd = open ("/dev/null", O_RDONLY);
+        if (fd < 0) {
+            printf ("WiFiCl: canned /dev/null: %s\n", strerror(errno));
             return (false);
         }
 
-        /* create socket */
-        sockfd = ::socket (aip->ai_family, aip->ai_socktype, aip->ai_protocol);
-        if (sockfd < 0) {
-            freeaddrinfo (aip);
-            printf ("socket(%s:%d): %s\n", host, port, strerror(errno));
-	    return (false);
+        if (_trace_client) printf ("WiFiCl: canned %s:%d fd %d\n", host, port, fd);
+	socket = fd;
+	n_peek = 0;
+        next_peek = 0;
+        canned = true;
+        canned_sent = false;
+        canned_req.clear();
+        return (true);
+}
+
+/* collect writes to a canned connection until the request line is complete, then find the file in
+ * canned_dir that matches its GET page, ignoring any query, and arrange for it to be read back after
+ * a minimal header. if no such file the reply is just a 404 header then EOF.
+ */
+void WiFiClient::cannedRequest (const uint8_t *buf, int n)
+{
+        canned_req.append ((const char *)buf, n);
+        if (canned_req.find ('\n') == std::string::npos)
+            return;
+        canned_sent = true;
+
+        char page[1000];
+        if (sscanf (canned_req.c_str(), "GET %999s", page) != 1) {
+            printf ("WiFiCl: canned request not understood: %s\n", canned_req.c_str());
+            return;
+        }
+        char *query = strchr (page, '?');
+        if (query)
+            *query = '\0';
+
+        std::string path = std::string(canned_dir) + page;
+        int fd = open (path.c_str(), O_RDONLY);
+        struct stat st;
+        if (fd >= 0 && fstat (fd, &st) == 0) {
+            dup2 (fd, socket);
+            close (fd);
+            n_peek = snprintf ((char*)peek, sizeof(peek), "HTTP/1.0 200 OK\r\nContent-Length: %ld\r\n\r\n",
+                                        (long)st.st_size);
+            if (_trace_client) printf ("WiFiCl: canned %s\n", path.c_str());
+        } else {
+            if (fd >= 0)
+                close (fd);
+            n_peek = snprintf ((char*)peek, sizeof(peek), "HTTP/1.0 404 Not Found\r\n\r\n");
+            printf ("WiFiCl: canned %s: %s\n", path.c_str(), strerror(errno));
         }
+        next_peek = 0;
+}
 
-        /* connect */
-        if (connect_to (sockfd, aip->ai_addr, aip->ai_addrlen, 5000) < 0) {
+bool WiFiClient::connect(const char *host, int port)
+{
+        int sockfd;
+
+        /* never touch the network when canned */
+        if (canned_dir)
+            return (cannedConnect (host, port));
+
+        /* reuse an idle socket if possible */
+        char port_str[16];
+        sprintf (port_str, "%d", port);
+        std::string hp = std::string(host) + ":" + port_str;
+        sockfd = poolGet (hp);
+        if (sockfd >= 0) {
+            printf ("WiFiCl: reusing %s socket %d\n", hp.c_str(), sockfd);
+            socket = sockfd;
+            n_peek = 0;
+            next_peek = 0;
+            canned = canned_sent = false;
+            resetHTTP();
+            http_reused = true;
+            host_port = hp;
+            return (true);
+        }
+
+        /* try cached address first, then fresh lookup if that fails */
+        for (int attempt = 0; ; attempt++) {
+
+            struct sockaddr_in addr;
+            bool cached;
+            if (!dnsLookup (host, addr, &cached))
+                return (false);
+            addr.sin_port = htons (port);
+
+            /* create socket */
+            sockfd = ::socket (AF_INET, SOCK_STREAM, 0);
+            if (sockfd < 0) {
+                printf ("socket(%s:%d): %s\n", host, port, strerror(errno));
+                return (false);
+            }
+
+            /* connect */
+            if (connect_to (sockfd, (struct sockaddr *)&addr, sizeof(addr), 5000) == 0)
+                break;
             printf ("connect(%s,%d): %s\n", host,port,strerror(errno));
-            freeaddrinfo (aip);
             close (sockfd);
-            return (false);
+            if (!cached || attempt > 0)
+                return (false);
+            dnsForget (host);
         }
 
         /* handle write errors inline */
@@ -132,10 +390,12 @@ bool WiFiClient::connect(const char *host, int port)
 
         /* ok */
         printf ("WiFiCl: new %s:%d socket %d\n", host, port, sockfd);
-        freeaddrinfo (aip);
 	socket = sockfd;
 	n_peek = 0;
         next_peek = 0;
+        canned = canned_sent = false;
+        resetHTTP();
+        host_port = hp;
         return (true);
 }
 
@@ -157,30 +417,46 @@ void WiFiClient::setNoDelay(bool on)
 void WiFiClient::stop()
 {
 	if (socket >= 0) {
+
+            // keep for reuse if the response is complete and the server agrees
+            if (!canned && http_keep && http_state != HS_DONE) {
+                drainHTTP();
+                if (socket < 0)
+                    return;                             // closed while draining
+            }
+            if (!canned && http_keep && http_state == HS_DONE && next_peek >= n_peek) {
+                printf ("WiFiCl: socket %d to %s is now idle\n", socket, host_port.c_str());
+                poolPut (host_port, socket);
+                socket = -1;
+                n_peek = 0;
+                next_peek = 0;
+                resetHTTP();
+                return;
+            }
+
             printf ("WiFiCl: socket %d is now closed\n", socket);
-	    shutdown (socket, SHUT_RDWR);
+            if (!canned)
+                shutdown (socket, SHUT_RDWR);
 	    close (socket);
 	    socket = -1;
 	    n_peek = 0;
             next_peek = 0;
+            canned = canned_sent = false;
+            resetHTTP();
 	}
 }
 
 bool WiFiClient::connected()
 {
-	return (socket >= 0);
+        // a complete HTTP response looks the same as the server closing
+	return (socket >= 0 && http_state != HS_DONE);
 }
 
-int WiFiClient::available()
+/* read more from socket into peek[] without blocking.
+ * return whether any new bytes are available.
+ */
+bool WiFiClient::fillPeek()
 {
-        // none if closed
-        if (socket < 0)
-            return (0);
-
-        // simple if unread bytes already available
-	if (next_peek < n_peek)
-	    return (1);
-
         // don't block if nothing available
         struct timeval tv;
         fd_set rset;
@@ -191,32 +467,221 @@ int WiFiClient::available()
         int s = select (socket+1, &rset, NULL, NULL, &tv);
         if (s < 0) {
             printf ("socket %d select err: %s\n", socket, strerror(errno));
+            http_keep = false;
 	    stop();
-	    return (0);
+	    return (false);
 	}
         if (s == 0)
-            return (0);
+            return (false);
 
         // read more
 	int n = ::read(socket, peek, sizeof(peek));
 	if (n > 0) {
 	    n_peek = n;
             next_peek = 0;
-	    return (1);
+            if (http_state != HS_NONE)
+                http_got_resp = true;
+	    return (true);
 	} else {
+            // a reused socket may have been closed by the server just as we sent the request
+            if (http_reused && !http_got_resp && http_state == HS_HEADER)
+                return (resendHTTP());
             if (n == 0)
                 printf ("WiFiCl: socket %d read EOF\n", socket);
             else
                 printf ("WiFiCl: socket %d read err: %s\n", socket, strerror(errno));
+            http_keep = false;
 	    stop();
-	    return (0);
+	    return (false);
 	}
 }
 
+/* replace the socket with a fresh connection and send the same request again.
+ * return false since no new bytes are yet available, or on error the socket is closed.
+ */
+bool WiFiClient::resendHTTP()
+{
+        printf ("WiFiCl: reused socket %d closed by server, retrying\n", socket);
+        close (socket);
+        socket = -1;
+
+        std::string req = http_req;
+        std::string hp = host_port;
+        size_t colon = hp.rfind (':');
+        std::string host = hp.substr (0, colon);
+        int port = atoi (hp.c_str() + colon + 1);
+
+        // new connection, then send again as if the caller had just written it.
+        // N.B. connect() may reuse another idle socket, which could fail likewise but the pool is small
+        if (connect (host.c_str(), port))
+            (void) write ((const uint8_t *)req.c_str(), req.size());
+        return (false);
+}
+
+/* absorb bytes at peek[next_peek] that are HTTP framing, not for the caller.
+ * return whether any were absorbed.
+ */
+bool WiFiClient::absorbHTTP()
+{
+        bool absorbed = false;
+
+        while (next_peek < n_peek) {
+            int c = peek[next_peek];
+
+            if (http_state == HS_CHUNK_SIZE || http_state == HS_TRAILER) {
+                next_peek++;
+                absorbed = true;
+                if (c != '\n') {
+                    if (http_line.size() < 100)
+                        http_line += (char)c;
+                    continue;
+                }
+                if (!http_line.empty() && http_line[http_line.size()-1] == '\r')
+                    http_line.erase (http_line.size()-1);
+                if (http_state == HS_CHUNK_SIZE) {
+                    // chunk size is hex, ignore any extensions
+                    http_left = strtol (http_line.c_str(), NULL, 16);
+                    if (http_left > 0)
+                        http_state = HS_CHUNK_DATA;
+                    else
+                        http_state = HS_TRAILER;
+                } else if (http_line.empty())
+                    http_state = HS_DONE;
+                http_line.clear();
+
+            } else if (http_state == HS_CHUNK_CRLF) {
+                next_peek++;
+                absorbed = true;
+                if (c == '\n')
+                    http_state = HS_CHUNK_SIZE;
+
+            } else
+                break;
+        }
+
+        return (absorbed);
+}
+
+/* inspect one complete response header line in http_line
+ */
+void WiFiClient::crackHTTPLine()
+{
+        const char *l = http_line.c_str();
+        int major, minor;
+
+        if (sscanf (l, "HTTP/%d.%d %d", &major, &minor, &http_status) == 3) {
+            // 1.1 defaults to keep-alive, 1.0 to close
+            http_keep = major > 1 || (major == 1 && minor >= 1);
+        } else if (strncasecmp (l, "Content-Length:", 15) == 0) {
+            http_clen = atol (l+15);
+        } else if (strncasecmp (l, "Transfer-Encoding:", 18) == 0) {
+            http_chunked = strcasestr (l+18, "chunked") != NULL;
+        } else if (strncasecmp (l, "Connection:", 11) == 0) {
+            if (strcasestr (l+11, "close"))
+                http_keep = false;
+            else if (strcasestr (l+11, "keep-alive"))
+                http_keep = true;
+        }
+}
+
+/* header is complete, decide how the body is framed
+ */
+void WiFiClient::startHTTPBody()
+{
+        if (http_status == 204 || http_status == 304) {
+            http_state = HS_DONE;
+        } else if (http_chunked) {
+            http_state = HS_CHUNK_SIZE;
+        } else if (http_clen > 0) {
+            http_left = http_clen;
+            http_state = HS_BODY_LEN;
+        } else if (http_clen == 0) {
+            http_state = HS_DONE;
+        } else {
+            http_state = HS_BODY_EOF;
+            http_keep = false;
+        }
+}
+
+/* account for byte c just passed to the caller
+ */
+void WiFiClient::deliverHTTP (int c)
+{
+        switch (http_state) {
+        case HS_HEADER:
+            if (c != '\n') {
+                if (http_line.size() < 200)
+                    http_line += (char)c;
+                break;
+            }
+            if (!http_line.empty() && http_line[http_line.size()-1] == '\r')
+                http_line.erase (http_line.size()-1);
+            if (http_line.empty())
+                startHTTPBody();
+            else
+                crackHTTPLine();
+            http_line.clear();
+            break;
+        case HS_BODY_LEN:
+            if (--http_left == 0)
+                http_state = HS_DONE;
+            break;
+        case HS_CHUNK_DATA:
+            if (--http_left == 0)
+                http_state = HS_CHUNK_CRLF;
+            break;
+        default:
+            break;
+        }
+}
+
+/* read and discard the remainder of a response so the socket may be reused.
+ * give up if it is large or slow to arrive, the socket then just gets closed.
+ */
+void WiFiClient::drainHTTP()
+{
+        if ((http_state == HS_BODY_LEN || http_state == HS_CHUNK_DATA) && http_left > 65536)
+            return;
+
+        struct timespec t0, t1;
+        clock_gettime (CLOCK_MONOTONIC, &t0);
+        while (socket >= 0 && http_state != HS_DONE) {
+            if (available())
+                (void) read();
+            else {
+                clock_gettime (CLOCK_MONOTONIC, &t1);
+                if ((t1.tv_sec-t0.tv_sec)*1000 + (t1.tv_nsec-t0.tv_nsec)/1000000 > 100)
+                    break;
+                usleep (1000);
+            }
+        }
+}
+
+int WiFiClient::available()
+{
+        // none if closed or the HTTP response is complete
+        while (socket >= 0 && http_state != HS_DONE) {
+
+            // read more if nothing unread
+            if (next_peek >= n_peek && !fillPeek())
+                return (0);
+
+            // skip over framing, then any remaining byte is for the caller
+            absorbHTTP();
+            if (next_peek < n_peek && http_state != HS_DONE)
+                return (1);
+        }
+
+        return (0);
+}
+
 int WiFiClient::read()
 {
-	if (available())
-            return (peek[next_peek++]);
+	if (available()) {
+            int c = peek[next_peek++];
+            deliverHTTP (c);
+            return (c);
+        }
 	return (-1);
 }
 
@@ -226,10 +691,33 @@ int WiFiClient::write (const uint8_t *buf, int n)
         if (socket < 0)
             return (0);
 
+        // an HTTP GET starts a new exchange whose response we frame, see available().
+        // N.B. the rest of the request arrives in later calls
+        if ((http_state == HS_NONE || http_state == HS_DONE) && n >= 4 && memcmp (buf, "GET ", 4) == 0) {
+            bool reused = http_reused;
+            resetHTTP();
+            http_reused = reused;
+            http_state = HS_HEADER;
+        }
+        if (http_reused && http_state == HS_HEADER && !http_got_resp)
+            http_req.append ((const char *)buf, n);
+
+        // canned connections only care about the request line, the rest is dropped
+        if (canned) {
+            if (!canned_sent)
+                cannedRequest (buf, n);
+            return (n);
+        }
+
 	int nw;
 	for (int ntot = 0; ntot < n; ntot += nw) {
 	    nw = ::write (socket, buf+ntot, n-ntot);
 	    if (nw < 0) {
+                // reused socket may have been closed by the server, request so far is in http_req
+                if (http_reused && !http_got_resp && http_state == HS_HEADER) {
+                    (void) resendHTTP();
+                    return (socket >= 0 ? n : 0);
+                }
 		printf ("write: %s\n", strerror(errno));
                 stop();         // avoid repeated failed attempts
 		return (0);
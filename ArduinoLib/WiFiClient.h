@@ -23,8 +23,13 @@
 #include <netinet/tcp.h>
 #include <netdb.h>
 #include <arpa/inet.h>
+#include <poll.h>
 
-/* version of Arduino WiFiClient that runs on rasp pi
+/* version of Arduino WiFiClient that runs on rasp pi.
+ *
+ * unlike the ESP version, when the client sends an HTTP GET we follow the response framing, ie
+ * Content-Length or chunked, so the caller sees the end of the body as if the server closed and the socket
+ * may then be kept open for reuse by the next connect() to the same host and port.
  */
 
 #include "Arduino.h"
@@ -64,7 +69,45 @@ class WiFiClient {
   	uint8_t peek[4096];             // read-ahead buffer
   	int n_peek;                     // n useful values in peek[]
         int next_peek;                  // next peek[] index to use
+        bool canned;                    // set when socket is a canned_dir file, not a network socket
+        bool canned_sent;               // set once the canned request line has been handled
+        std::string canned_req;         // canned request line so far
 
+        bool cannedConnect (const char *host, int port);
+        void cannedRequest (const uint8_t *buf, int n);
+
+        // HTTP response framing state
+        typedef enum {
+            HS_NONE,                    // not framing, data ends when server closes
+            HS_HEADER,                  // passing response header, learning framing
+            HS_BODY_LEN,                // passing body of http_left bytes
+            HS_BODY_EOF,                // passing body that ends when server closes
+            HS_CHUNK_SIZE,              // absorbing chunk size line
+            HS_CHUNK_DATA,              // passing chunk data of http_left bytes
+            HS_CHUNK_CRLF,              // absorbing CRLF after chunk data
+            HS_TRAILER,                 // absorbing trailer after last chunk
+            HS_DONE,                    // response complete
+        } HTTPState;
+        HTTPState http_state;
+        std::string http_line;          // header or chunk size line so far
+        long http_left;                 // bytes remaining in body or chunk
+        long http_clen;                 // Content-Length or -1
+        int http_status;                // response status code
+        bool http_chunked;              // Transfer-Encoding: chunked
+        bool http_keep;                 // server allows connection to remain open
+        bool http_reused;               // socket came from the idle pool
+        bool http_got_resp;             // received any of the response
+        std::string http_req;           // request as sent on a reused socket, in case it must be resent
+        std::string host_port;          // "host:port" of this connection, for the pool
+
+        void resetHTTP (void);
+        bool fillPeek (void);
+        bool absorbHTTP (void);
+        void deliverHTTP (int c);
+        void crackHTTPLine (void);
+        void startHTTPBody (void);
+        bool resendHTTP (void);
+        void drainHTTP (void);
 
         int connect_to (int sockfd, struct sockaddr *serv_addr, int addrlen, int to_ms);
         int tout (int to_ms, int fd);
@@ -0,0 +1,267 @@
+/* benchmark harness for the innermost map projection and rendering kernels.
+ *
+ * Built only by "make bench" as one headless program per build size with -D_BENCH, in which case main()
+ * calls runBenchmarks() instead of setup() and loop(). Each measurement is written to stdout as one JSON
+ * object per line so results can be collected and compared release over release, for example:
+ *
+ *   {"build":"hamclock-headless-800x480","scalesz":1,"proj":"mercator","kernel":"s2ll","calls":217800,"ns":41.2}
+ *
+ * where ns is the mean nanoseconds per call. proj is "none" for kernels that do not depend on projection.
+ */
+
+#include "HamClock.h"
+
+#if defined(_BENCH)
+
+#include <time.h>
+
+// repetitions of each full sweep, more is steadier but slower
+#define BENCH_REPS      3
+
+// sink for results so the compiler can not discard the work being timed
+static volatile float bench_sink;
+
+/* return monotonic time in ns
+ */
+static double benchNS (void)
+{
+    struct timespec ts;
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec*1e9 + ts.tv_nsec);
+}
+
+/* print one result line
+ */
+static void benchReport (const char *proj, const char *kernel, long calls, double t0, double t1)
+{
+    printf ("{\"build\":\"%s\",\"scalesz\":%d,\"proj\":\"%s\",\"kernel\":\"%s\",\"calls\":%ld,\"ns\":%.1f}\n",
+            our_make, tft.SCALESZ, proj, kernel, calls, calls > 0 ? (t1-t0)/calls : 0.0);
+}
+
+/* fill both map arrays with a repeatable pattern and install them and their native versions as if
+ * loaded from files
+ */
+static void benchEarthPix (void)
+{
+    size_t npix = EARTH_BIG_W*EARTH_BIG_H;
+    uint16_t *day = (uint16_t *) malloc (npix*sizeof(uint16_t));
+    uint16_t *night = (uint16_t *) malloc (npix*sizeof(uint16_t));
+    if (!day || !night) {
+        printf ("bench: no memory for %ld map pixels\n", (long)npix);
+        exit(1);
+    }
+    for (size_t i = 0; i < npix; i++) {
+        day[i] = (uint16_t)(i*2654435761U >> 16);
+        night[i] = day[i] >> 2;
+    }
+    tft.setEarthPix ((char*)day, (char*)night);
+
+    fbpix_t *day_fb = (fbpix_t *) malloc (npix*sizeof(fbpix_t));
+    fbpix_t *night_fb = (fbpix_t *) malloc (npix*sizeof(fbpix_t));
+    if (!day_fb || !night_fb) {
+        printf ("bench: no memory for %ld native map pixels\n", (long)npix);
+        exit(1);
+    }
+    for (size_t i = 0; i < npix; i++) {
+        day_fb[i] = RGB16TOFBPIX(day[i]);
+        night_fb[i] = RGB16TOFBPIX(night[i]);
+    }
+    tft.setEarthFBPix ((char*)day_fb, (char*)night_fb);
+}
+
+/* time the kernels that depend on the current projection
+ */
+static void benchProjection (const char *proj)
+{
+    const long n_map = (long)map_b.w*map_b.h;
+    double t0, t1;
+    long n;
+
+    // s2ll over every map pixel, also saved for plotEarth
+    LatLong *ll = (LatLong *) malloc (n_map * sizeof(LatLong));
+    bool *ok = (bool *) malloc (n_map * sizeof(bool));
+    n = 0;
+    t0 = benchNS();
+    for (int rep = 0; rep < BENCH_REPS; rep++) {
+        for (uint16_t y = map_b.y; y < map_b.y + map_b.h; y++) {
+            for (uint16_t x = map_b.x; x < map_b.x + map_b.w; x++) {
+                long i = (long)(y-map_b.y)*map_b.w + (x-map_b.x);
+                ok[i] = s2ll (x, y, ll[i]);
+                n++;
+            }
+        }
+    }
+    t1 = benchNS();
+    benchReport (proj, "s2ll", n, t0, t1);
+
+    // ll2s over a 1 degree grid of the globe
+    n = 0;
+    t0 = benchNS();
+    for (int rep = 0; rep < BENCH_REPS; rep++) {
+        for (int lat = -90; lat <= 90; lat++) {
+            for (int lng = -180; lng < 180; lng++) {
+                SCoord s;
+                ll2s (deg2rad(lat), deg2rad(lng), s, 0);
+                bench_sink = s.x + s.y;
+                n++;
+            }
+        }
+    }
+    t1 = benchNS();
+    benchReport (proj, "ll2s", n, t0, t1);
+
+    // full map sweep exactly as drawMoreEarth does it
+    n = 0;
+    t0 = benchNS();
+    for (int rep = 0; rep < BENCH_REPS; rep++) {
+        for (uint16_t y = map_b.y; y < map_b.y + map_b.h; y++) {
+            for (uint16_t x = map_b.x; x < map_b.x + map_b.w; x++) {
+                drawMapCoord (x, y);
+                n++;
+            }
+        }
+    }
+    t1 = benchNS();
+    benchReport (proj, "drawMapCoord", n, t0, t1);
+
+    // just the plotEarth portion, using the gradients found above and a twilight blend
+    n = 0;
+    t0 = benchNS();
+    for (int rep = 0; rep < BENCH_REPS; rep++) {
+        for (uint16_t y = map_b.y; y < map_b.y + map_b.h - 1; y++) {
+            for (uint16_t x = map_b.x; x < map_b.x + map_b.w - 1; x++) {
+                long i = (long)(y-map_b.y)*map_b.w + (x-map_b.x);
+                if (!ok[i])
+                    continue;
+                LatLong &s = ll[i];
+                LatLong &r = ok[i+1] ? ll[i+1] : s;
+                LatLong &d = ok[i+map_b.w] ? ll[i+map_b.w] : s;
+                tft.plotEarth (x, y, s.lat_d, s.lng_d, r.lat_d - s.lat_d, r.lng_d - s.lng_d,
+                                d.lat_d - s.lat_d, d.lng_d - s.lng_d, (x & 1) ? 1.0F : 0.5F);
+                n++;
+            }
+        }
+    }
+    t1 = benchNS();
+    benchReport (proj, "plotEarth", n, t0, t1);
+
+    free (ll);
+    free (ok);
+}
+
+/* time the kernels that do not depend on projection
+ */
+static void benchOthers (void)
+{
+    double t0, t1;
+    long n;
+
+    // solveSphere over a range of angles
+    n = 0;
+    t0 = benchNS();
+    for (int rep = 0; rep < 100*BENCH_REPS; rep++) {
+        for (int i = 0; i < 1000; i++) {
+            float ca, B;
+            solveSphere (i*0.00628F, i*0.00314F, sdelat, cdelat, &ca, &B);
+            bench_sink = ca + B;
+            n++;
+        }
+    }
+    t1 = benchNS();
+    benchReport ("none", "solveSphere", n, t0, t1);
+
+    // getTZ over a 1 degree grid
+    n = 0;
+    t0 = benchNS();
+    for (int rep = 0; rep < BENCH_REPS; rep++) {
+        for (int lat = -89; lat <= 89; lat++) {
+            for (int lng = -180; lng < 180; lng++) {
+                LatLong ll;
+                ll.lat_d = lat;
+                ll.lng_d = lng;
+                normalizeLL (ll);
+                bench_sink = getTZ (ll);
+                n++;
+            }
+        }
+    }
+    t1 = benchNS();
+    benchReport ("none", "getTZ", n, t0, t1);
+
+    // nearestPrefix over a 5 degree grid, beware its one-entry cache
+    n = 0;
+    t0 = benchNS();
+    for (int rep = 0; rep < BENCH_REPS; rep++) {
+        for (int lat = -85; lat <= 85; lat += 5) {
+            for (int lng = -180; lng < 180; lng += 5) {
+                LatLong ll;
+                ll.lat_d = lat;
+                ll.lng_d = lng;
+                normalizeLL (ll);
+                char prefix[MAX_PREF_LEN+1];
+                bench_sink = nearestPrefix (ll, prefix);
+                n++;
+            }
+        }
+    }
+    t1 = benchNS();
+    benchReport ("none", "nearestPrefix", n, t0, t1);
+
+    // maidenhead both ways over a 1 degree grid
+    n = 0;
+    t0 = benchNS();
+    for (int rep = 0; rep < BENCH_REPS; rep++) {
+        for (int lat = -89; lat <= 89; lat++) {
+            for (int lng = -180; lng < 180; lng++) {
+                LatLong ll;
+                ll.lat_d = lat + 0.5F;
+                ll.lng_d = lng + 0.5F;
+                normalizeLL (ll);
+                char maid[MAID_CHARLEN];
+                ll2maidenhead (maid, ll);
+                maidenhead2ll (ll, maid);
+                bench_sink = ll.lat_d;
+                n++;
+            }
+        }
+    }
+    t1 = benchNS();
+    benchReport ("none", "maidenhead", n, t0, t1);
+}
+
+/* run all benchmarks then return.
+ * N.B. we set up just enough of the real application state for the kernels to run.
+ */
+void runBenchmarks (void)
+{
+    // display and geometry as per setup()
+    tft.begin (RA8875_800x480);
+    map_b.w = EARTH_W;
+    map_b.h = EARTH_H;
+    map_b.x = tft.width() - map_b.w - 1;
+    map_b.y = tft.height() - map_b.h - 1;
+    benchEarthPix();
+
+    // fixed DE and sun so every run does the same work
+    de_ll.lat_d = 40;
+    de_ll.lng_d = -105;
+    normalizeLL (de_ll);
+    sdelat = sinf(de_ll.lat);
+    cdelat = cosf(de_ll.lat);
+    sun_ss_ll.lat_d = 10;
+    sun_ss_ll.lng_d = 30;
+    normalizeLL (sun_ss_ll);
+    csslat = cosf(sun_ss_ll.lat);
+    ssslat = sinf(sun_ss_ll.lat);
+    night_on = 1;
+    setCenterLng (0);
+
+    azm_on = 0;
+    benchProjection ("mercator");
+    azm_on = 1;
+    benchProjection ("azimuthal");
+
+    benchOthers();
+}
+
+#endif // _BENCH
@@ -1024,6 +1024,90 @@ void ll2s (const LatLong &ll, SCoord &s, uint8_t edge)
 
 }
 
+/* convert a screen coord known to be over the map to lat and long in azimuthal projection.
+ * return whether location is really over the globe.
+ */
+static bool s2llAzm (const SCoord &s, LatLong &ll)
+{
+    // radius from center of point's hemisphere
+    bool on_right = s.x > map_b.x + map_b.w/2;
+    int32_t dx = on_right ? s.x - (map_b.x + 3*map_b.w/4) : s.x - (map_b.x + map_b.w/4);
+    int32_t dy = (map_b.y + map_b.h/2) - s.y;
+    int32_t r2 = dx*dx + dy*dy;
+
+    // see if really on surface
+    int32_t w2 = map_b.w*map_b.w/16;
+    if (r2 > w2)
+        return(false);
+
+    // use screen triangle to find globe
+    float b = sqrtf((float)r2/w2)*(M_PI_2F);
+    float A = (M_PI_2F) - atan2f (dy, dx);
+    float ca, B;
+    solveSphere (A, b, (on_right ? -1 : 1) * sdelat, cdelat, &ca, &B);
+    float lt = M_PI_2F - acosf(ca);
+    ll.lat_d = rad2deg(lt);
+    float lg = fmodf (de_ll.lng + B + (on_right?6:5)*M_PIF, 2*M_PIF) - M_PIF;
+    ll.lng_d = rad2deg(lg);
+
+    normalizeLL(ll);
+
+    return (true);
+}
+
+#if defined(_IS_UNIX)
+
+/* the azimuthal projection of each map_b pixel depends only on DE and map_b, so we cache s2llAzm() for
+ * every pixel and only recompute when either changes, making azimuthal s2ll() just a table lookup.
+ * values are in units of 0.01 degree, much finer than one EARTH_BIG pixel.
+ */
+typedef struct {
+    int16_t lat, lng;                           // 0.01 degrees, or AZM_OFFGLOBE
+} AzmLL;
+#define AZM_OFFGLOBE    (-32768)                // lat value of pixels not on the globe
+static AzmLL *azm_table;                        // map_b.w x map_b.h, malloced
+static float azm_sdelat, azm_cdelat, azm_delng; // DE for which azm_table was built
+static SBox azm_b;                              // map_b for which azm_table was built
+
+/* insure azm_table matches the current DE and map_b
+ */
+static void checkAzmTable()
+{
+    // skip if still good
+    if (azm_table && azm_sdelat == sdelat && azm_cdelat == cdelat && azm_delng == de_ll.lng
+                && memcmp (&azm_b, &map_b, sizeof(azm_b)) == 0)
+        return;
+
+    // (re)alloc, map_b size may have changed
+    azm_table = (AzmLL *) realloc (azm_table, map_b.w * map_b.h * sizeof(AzmLL));
+    if (!azm_table)
+        fatalError (_FX("No memory for azimuthal table %d x %d"), map_b.w, map_b.h);
+
+    // fill
+    AzmLL *ap = azm_table;
+    SCoord s;
+    for (s.y = map_b.y; s.y < map_b.y + map_b.h; s.y++) {
+        for (s.x = map_b.x; s.x < map_b.x + map_b.w; s.x++, ap++) {
+            LatLong ll;
+            if (s2llAzm (s, ll)) {
+                ap->lat = (int16_t) roundf (100*ll.lat_d);
+                ap->lng = (int16_t) roundf (100*ll.lng_d);
+                if (ap->lng >= 18000)
+                    ap->lng -= 36000;
+            } else
+                ap->lat = AZM_OFFGLOBE;
+        }
+    }
+
+    // record key
+    azm_sdelat = sdelat;
+    azm_cdelat = cdelat;
+    azm_delng = de_ll.lng;
+    azm_b = map_b;
+}
+
+#endif // _IS_UNIX
+
 /* convert a screen coord to lat and long.
  * return whether location is really over valid map.
  */
@@ -1041,26 +1125,24 @@ bool s2ll (const SCoord &s, LatLong &ll)
 
     if (azm_on) {
 
-        // radius from center of point's hemisphere
-        bool on_right = s.x > map_b.x + map_b.w/2;
-        int32_t dx = on_right ? s.x - (map_b.x + 3*map_b.w/4) : s.x - (map_b.x + map_b.w/4);
-        int32_t dy = (map_b.y + map_b.h/2) - s.y;
-        int32_t r2 = dx*dx + dy*dy;
+        #if defined(_IS_UNIX)
 
-        // see if really on surface
-        int32_t w2 = map_b.w*map_b.w/16;
-        if (r2 > w2)
-            return(false);
+            // look up in table
+            checkAzmTable();
+            const AzmLL &a = azm_table[(s.y - map_b.y)*map_b.w + (s.x - map_b.x)];
+            if (a.lat == AZM_OFFGLOBE)
+                return (false);
+            ll.lat_d = 0.01F*a.lat;
+            ll.lat = deg2rad(ll.lat_d);
+            ll.lng_d = 0.01F*a.lng;
+            ll.lng = deg2rad(ll.lng_d);
+            return (true);
 
-        // use screen triangle to find globe
-        float b = sqrtf((float)r2/w2)*(M_PI_2F);
-        float A = (M_PI_2F) - atan2f (dy, dx);
-        float ca, B;
-        solveSphere (A, b, (on_right ? -1 : 1) * sdelat, cdelat, &ca, &B);
-        float lt = M_PI_2F - acosf(ca);
-        ll.lat_d = rad2deg(lt);
-        float lg = fmodf (de_ll.lng + B + (on_right?6:5)*M_PIF, 2*M_PIF) - M_PIF;
-        ll.lng_d = rad2deg(lg);
+        #else
+
+            return (s2llAzm (s, ll));
+
+        #endif // _IS_UNIX
 
     } else {
 
@@ -1069,11 +1151,10 @@ bool s2ll (const SCoord &s, LatLong &ll)
         ll.lat_d = 90 - 180.0F*(s.y - map_b.y)/(EARTH_H);
         ll.lng_d = fmodf(360.0F*(s.x - map_b.x)/(EARTH_W)+getCenterLng()+720,360) - 180;
 
-    }
-
-    normalizeLL(ll);
+        normalizeLL(ll);
 
-    return (true);
+        return (true);
+    }
 }
 
 /* given numeric difference between two longitudes in degrees, return shortest diff
@@ -1269,23 +1350,6 @@ void drawMapCoord (const SCoord &s)
         if (!s2ll(s,lls))
             return; 
 
-        /* even though we only draw one application point, s, plotEarth needs points r and d to
-         * interpolate to full map resolution.
-         *   s - - - r
-         *   |
-         *   d
-         */
-        SCoord sr, sd;
-        LatLong llr, lld;
-        sr.x = s.x + 1;
-        sr.y = s.y;
-        if (!s2ll(sr,llr))
-            llr = lls;
-        sd.x = s.x;
-        sd.y = s.y + 1;
-        if (!s2ll(sd,lld))
-            lld = lls;
-
         // find angle between subsolar point and any visible near this location
         // TODO: actually different at each subpixel, this causes striping
         float clat = cosf(lls.lat);
@@ -1305,6 +1369,29 @@ void drawMapCoord (const SCoord &s)
             fract_day = 0;
         }
 
+        // mercator map pixels depend only on screen location so no need for gradients
+        if (!azm_on) {
+            tft.plotEarthMerc (s.x, s.y, map_b.x, map_b.y, getCenterLng(), fract_day);
+            return;
+        }
+
+        /* even though we only draw one application point, s, plotEarth needs points r and d to
+         * interpolate to full map resolution.
+         *   s - - - r
+         *   |
+         *   d
+         */
+        SCoord sr, sd;
+        LatLong llr, lld;
+        sr.x = s.x + 1;
+        sr.y = s.y;
+        if (!s2ll(sr,llr))
+            llr = lls;
+        sd.x = s.x;
+        sd.y = s.y + 1;
+        if (!s2ll(sd,lld))
+            lld = lls;
+
         // draw the full res map point
         tft.plotEarth (s.x, s.y, lls.lat_d, lls.lng_d, llr.lat_d - lls.lat_d, llr.lng_d - lls.lng_d,
                     lld.lat_d - lls.lat_d, lld.lng_d - lls.lng_d, fract_day);
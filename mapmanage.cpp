@@ -305,6 +305,7 @@ static void cleanFLASH (const char *title, int need_room)
 #include <unistd.h>
 #include <errno.h>
 #include <time.h>
+#include <fcntl.h>
 #include <sys/stat.h>
 #include <sys/mman.h>
 
@@ -314,6 +315,24 @@ static File day_file, night_file;                       // open LittleFS file ha
 static int day_fbytes, night_fbytes;                    // bytes mmap'ed
 static char *day_pixels, *night_pixels;                 // pixels mmap'ed
 
+#if !defined(_16BIT_FB)
+
+// each map is also cached in our_dir already resampled to EARTH_BIG_W x EARTH_BIG_H in the native fbpix_t
+// format so plotEarthMerc can copy whole rows. The header identifies the bmp version from which it was made.
+typedef struct {
+        char magic[4];                                  // FBPIX_MAGIC
+        uint16_t w, h;                                  // EARTH_BIG_W x EARTH_BIG_H
+        uint32_t bytespix;                              // BYTESPFBPIX
+        int64_t bmp_mtime;                              // bmp st_mtim when converted
+        int64_t bmp_mtime_ns;
+} FBPixHdr;
+#define FBPIX_MAGIC     "HCFB"
+#define FBPIX_SUFFIX    ".fbpix"
+static const size_t fbpix_bytes = sizeof(FBPixHdr) + (size_t)EARTH_BIG_W*EARTH_BIG_H*BYTESPFBPIX;
+static char *day_fbpix, *night_fbpix;                   // native maps mmap'ed, including FBPixHdr
+
+#endif // !_16BIT_FB
+
 
 // dummies for linking
 bool getMapDayPixel (uint16_t row, uint16_t col, uint16_t *nightp) { return (false); }
@@ -328,6 +347,19 @@ static void invalidatePixels()
 {
         // disconnect from tft thread
         tft.setEarthPix (NULL, NULL);
+        tft.setEarthFBPix (NULL, NULL);
+
+#if !defined(_16BIT_FB)
+        // unmap native arrays
+        if (day_fbpix) {
+            munmap (day_fbpix, fbpix_bytes);
+            day_fbpix = NULL;
+        }
+        if (night_fbpix) {
+            munmap (night_fbpix, fbpix_bytes);
+            night_fbpix = NULL;
+        }
+#endif // !_16BIT_FB
 
         // unmap pixel arrays
         if (day_pixels) {
@@ -340,6 +372,92 @@ static void invalidatePixels()
         }
 }
 
+#if !defined(_16BIT_FB)
+
+/* mmap the native fbpix_t version of the given bmp map file, first creating it from bmp_pix if missing
+ * or made from a different version of the bmp.
+ * return mmap'ed file including FBPixHdr, else NULL which is not fatal because the map is then just
+ * converted as it is drawn.
+ * UNIX version
+ */
+static char *mmapFBPix (const char *bmp_name, const uint16_t *bmp_pix)
+{
+        // cache file is the same name in the same dir but with a different suffix
+        std::string bmp_path = our_dir + bmp_name;
+        std::string fb_path = bmp_path.substr (0, bmp_path.rfind ('.')) + FBPIX_SUFFIX;
+
+        // header we expect
+        struct stat bs;
+        if (stat (bmp_path.c_str(), &bs) < 0) {
+            Serial.printf ("%s: %s\n", bmp_path.c_str(), strerror(errno));
+            return (NULL);
+        }
+        FBPixHdr hdr;
+        memset (&hdr, 0, sizeof(hdr));
+        memcpy (hdr.magic, FBPIX_MAGIC, sizeof(hdr.magic));
+        hdr.w = EARTH_BIG_W;
+        hdr.h = EARTH_BIG_H;
+        hdr.bytespix = BYTESPFBPIX;
+        hdr.bmp_mtime = bs.st_mtim.tv_sec;
+        hdr.bmp_mtime_ns = bs.st_mtim.tv_nsec;
+
+        // use existing file if it matches
+        int fd = open (fb_path.c_str(), O_RDONLY);
+        if (fd >= 0) {
+            FBPixHdr old_hdr;
+            struct stat fs;
+            if (read (fd, &old_hdr, sizeof(old_hdr)) != sizeof(old_hdr) || memcmp (&old_hdr, &hdr, sizeof(hdr))
+                                || fstat (fd, &fs) < 0 || (size_t)fs.st_size != fbpix_bytes) {
+                close (fd);
+                fd = -1;
+            }
+        }
+
+        // else create fresh from bmp_pix, renaming into place only when complete
+        if (fd < 0) {
+            std::string tmp_path = fb_path + ".tmp";
+            FILE *fp = fopen (tmp_path.c_str(), "w");
+            if (!fp) {
+                Serial.printf ("%s: %s\n", tmp_path.c_str(), strerror(errno));
+                return (NULL);
+            }
+            fbpix_t *row = (fbpix_t *) malloc (EARTH_BIG_W * sizeof(fbpix_t));
+            if (!row)
+                fatalError (_FX("No memory for map row"));
+            bool ok = fwrite (&hdr, sizeof(hdr), 1, fp) == 1;
+            for (int y = 0; ok && y < EARTH_BIG_H; y++) {
+                const uint16_t *bmp_row = &bmp_pix[(y*HC_MAP_H/EARTH_BIG_H)*HC_MAP_W];
+                for (int x = 0; x < EARTH_BIG_W; x++)
+                    row[x] = RGB16TOFBPIX(bmp_row[x*HC_MAP_W/EARTH_BIG_W]);
+                ok = fwrite (row, sizeof(fbpix_t), EARTH_BIG_W, fp) == EARTH_BIG_W;
+            }
+            free (row);
+            if (fclose (fp) != 0)
+                ok = false;
+            if (!ok || rename (tmp_path.c_str(), fb_path.c_str()) < 0) {
+                Serial.printf ("%s: %s\n", fb_path.c_str(), strerror(errno));
+                unlink (tmp_path.c_str());
+                return (NULL);
+            }
+            fd = open (fb_path.c_str(), O_RDONLY);
+            if (fd < 0) {
+                Serial.printf ("%s: %s\n", fb_path.c_str(), strerror(errno));
+                return (NULL);
+            }
+        }
+
+        // mmap, fd no longer needed after that
+        char *fbpix = (char *) mmap (NULL, fbpix_bytes, PROT_READ, MAP_FILE|MAP_PRIVATE, fd, 0);
+        close (fd);
+        if (fbpix == MAP_FAILED) {
+            Serial.printf ("%s mmap failed: %s\n", fb_path.c_str(), strerror(errno));
+            return (NULL);
+        }
+        return (fbpix);
+}
+
+#endif // !_16BIT_FB
+
 /* prepare open day_file and night_file for pixel access.
  * return whether ok
  * UNIX version
@@ -373,6 +491,17 @@ static bool installFilePixels (const char *dfile, const char *nfile)
             // install in tft at start of pixels
             tft.setEarthPix (day_pixels+BHDRSZ, night_pixels+BHDRSZ);
 
+            // also install native versions if possible
+#if defined(_16BIT_FB)
+            // bmp pixels are already native
+            tft.setEarthFBPix (day_pixels+BHDRSZ, night_pixels+BHDRSZ);
+#else
+            day_fbpix = mmapFBPix (dfile, (uint16_t*)(day_pixels+BHDRSZ));
+            night_fbpix = mmapFBPix (nfile, (uint16_t*)(night_pixels+BHDRSZ));
+            if (day_fbpix && night_fbpix)
+                tft.setEarthFBPix (day_fbpix+sizeof(FBPixHdr), night_fbpix+sizeof(FBPixHdr));
+#endif // _16BIT_FB
+
         } else {
 
             // no go -- clean up
@@ -0,0 +1,2 @@
+#include "HamClock.h"
+const uint16_t moon_image[HC_MOON_W*HC_MOON_H] PROGMEM = {0};
@@ -1254,6 +1254,14 @@ time_t getNTPUTC(const char **server)
     // if (!wifiOk())
     //    return (0);
 
+    #if !defined(_IS_ESP8266)
+        // repeatable fake clock never needs a real server
+        if (fake_clock_t0) {
+            *server = "fake clock";
+            return (fake_clock_t0 + millis()/1000);
+        }
+    #endif
+
     // create udp endpoint
     WiFiUDP ntp_udp;
     resetWatchdog();
@@ -1486,16 +1494,24 @@ void sendUserAgent (WiFiClient &client)
     client.print(ua);
 }
 
-/* issue an HTTP Get
+/* issue an HTTP Get.
+ * on UNIX the WiFiClient follows the response framing so the connection may be kept for reuse.
  */
 void httpGET (WiFiClient &client, const char *server, const char *page)
 {
     resetWatchdog();
 
+#if defined(_IS_UNIX)
+    FWIFIPR (client, F("GET ")); client.print(page); FWIFIPRLN (client, F(" HTTP/1.1"));
+    FWIFIPR (client, F("Host: ")); client.println (server);
+    sendUserAgent (client);
+    FWIFIPRLN (client, F("Connection: keep-alive\r\n"));
+#else
     FWIFIPR (client, F("GET ")); client.print(page); FWIFIPRLN (client, F(" HTTP/1.0"));
     FWIFIPR (client, F("Host: ")); client.println (server);
     sendUserAgent (client);
     FWIFIPRLN (client, F("Connection: close\r\n"));
+#endif
 
     resetWatchdog();
 }